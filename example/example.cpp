@@ -3,6 +3,7 @@
 
 // ASIO includes <- note that this is before AMS
 #include <asio.hpp>
+#include <asio/experimental/awaitable_operators.hpp>
 
 // AMS includes
 #include <asio-ministun/asio-ministun.hpp>
@@ -5,27 +5,131 @@
 #define AMS_ASIOMINISTUN_HPP_H_
 
 // AMS includes
+#include <asio-ministun/detail/batch.hpp>
 #include <asio-ministun/detail/common.hpp>
+#include <asio-ministun/detail/error.hpp>
+#include <asio-ministun/detail/error_response.hpp>
+#include <asio-ministun/detail/header.hpp>
+#include <asio-ministun/detail/redirect_cache.hpp>
 #include <asio-ministun/detail/xor_mapped_address.hpp>
 
+#ifdef AMS_SEPARATE_COMPILATION
+// asio includes for the completion tokens instantiated in the library
+#ifdef AMS_USE_BOOST
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/use_future.hpp>
+#else
+#include <asio/use_awaitable.hpp>
+#include <asio/use_future.hpp>
+#endif
+#endif
+
 // STL includes
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <optional>
+#include <span>
 #include <utility>
 
 namespace asio_miniSTUN
 {
-	/// @brief Get the IP address from a STUN server. Preserves the socket's non-blocking
-	/// and connected state as long as the operation does not encounter an OS-level error
+	/// @brief A received XOR-MAPPED-ADDRESS response. Contiguous arrays of responses can be
+	/// received into in bulk and validated with validate_responses
+	using response = detail::xor_mapped_address;
+
+	/// @brief A STUN transaction ID
+	using transaction_id = detail::header::transaction_id_type;
+
+	/// @brief A binding request. Send its to_const_buffers() to a STUN server
+	using request = detail::header;
+
+	/// @brief A cache of ALTERNATE-SERVER redirects, shared between requests
+	using redirect_cache = detail::redirect_cache;
+
+	/// @brief A STUN error response, with its reason phrase and UNKNOWN-ATTRIBUTES
+	using error_response = detail::error_response;
+
+	/// @brief The completion signature of async_get_address
+	using get_address_signature = detail::get_address_signature;
+
+	/// @brief The type-erased handler async_get_address is precompiled for
+	using get_address_handler = std::function<get_address_signature>;
+
+	/// @brief The initiating function result of async_get_address for a completion token
+	/// @tparam CompletionToken The completion token type
+	template<typename CompletionToken>
+	using get_address_result_t = detail::get_address_result_t<CompletionToken>;
+
+	/// @brief Get the IP address from a STUN server. Always restores the socket's non-blocking
+	/// state on completion, including on error and cancellation. With asio 1.19 or later,
+	/// supports terminal and partial cancellation through the handler's associated
+	/// cancellation slot, which cancels the pending receive immediately. Follows 300 Try
+	/// Alternate redirects, and completes with an error in stun_category for other error
+	/// responses
 	/// @tparam CompletionToken The completion token type
 	/// @param socket The socket to use
 	/// @param endpoint The STUN server endpoint
 	/// @param token The completion token
 	/// @return DEDUCED. Handler must be in the form void(asio::error_code, asio::ip::udp::endpoint)
 	template<typename CompletionToken>
-	auto async_get_address(asio::ip::udp::socket& socket,
+	get_address_result_t<CompletionToken> async_get_address(asio::ip::udp::socket& socket,
 		const asio::ip::udp::endpoint& endpoint, CompletionToken&& token)
 	{
-		return detail::async_get_address_impl(socket, endpoint,
+		return detail::async_get_address_impl(socket, endpoint, nullptr, nullptr,
+			std::forward<CompletionToken>(token));
+	}
+
+	/// @brief Get the IP address from a STUN server, as async_get_address. When the operation
+	/// completes with an error in stun_category, the error response is stored in error,
+	/// otherwise error is left unchanged
+	/// @tparam CompletionToken The completion token type
+	/// @param socket The socket to use
+	/// @param endpoint The STUN server endpoint
+	/// @param error Receives the error response. Must outlive the operation
+	/// @param token The completion token
+	/// @return DEDUCED. Handler must be in the form void(asio::error_code, asio::ip::udp::endpoint)
+	template<typename CompletionToken>
+	get_address_result_t<CompletionToken> async_get_address(asio::ip::udp::socket& socket,
+		const asio::ip::udp::endpoint& endpoint, error_response& error, CompletionToken&& token)
+	{
+		return detail::async_get_address_impl(socket, endpoint, nullptr, &error,
+			std::forward<CompletionToken>(token));
+	}
+
+	/// @brief Get the IP address from a STUN server, as async_get_address. Redirects are
+	/// recorded in the cache, and later requests to the same server go straight to the
+	/// cached alternate server until the redirect expires
+	/// @tparam CompletionToken The completion token type
+	/// @param socket The socket to use
+	/// @param endpoint The STUN server endpoint
+	/// @param cache The redirect cache. Must outlive the operation
+	/// @param token The completion token
+	/// @return DEDUCED. Handler must be in the form void(asio::error_code, asio::ip::udp::endpoint)
+	template<typename CompletionToken>
+	get_address_result_t<CompletionToken> async_get_address(asio::ip::udp::socket& socket,
+		const asio::ip::udp::endpoint& endpoint, redirect_cache& cache, CompletionToken&& token)
+	{
+		return detail::async_get_address_impl(socket, endpoint, &cache, nullptr,
+			std::forward<CompletionToken>(token));
+	}
+
+	/// @brief Get the IP address from a STUN server, as async_get_address with a redirect
+	/// cache. When the operation completes with an error in stun_category, the error response
+	/// is stored in error, otherwise error is left unchanged
+	/// @tparam CompletionToken The completion token type
+	/// @param socket The socket to use
+	/// @param endpoint The STUN server endpoint
+	/// @param cache The redirect cache. Must outlive the operation
+	/// @param error Receives the error response. Must outlive the operation
+	/// @param token The completion token
+	/// @return DEDUCED. Handler must be in the form void(asio::error_code, asio::ip::udp::endpoint)
+	template<typename CompletionToken>
+	get_address_result_t<CompletionToken> async_get_address(asio::ip::udp::socket& socket,
+		const asio::ip::udp::endpoint& endpoint, redirect_cache& cache, error_response& error,
+		CompletionToken&& token)
+	{
+		return detail::async_get_address_impl(socket, endpoint, &cache, &error,
 			std::forward<CompletionToken>(token));
 	}
 
@@ -37,12 +141,9 @@ namespace asio_miniSTUN
 	/// @param timeout The socket timeout
 	/// @param token The completion token
 	/// @return The deduced address from STUN
-	asio::ip::udp::endpoint get_address(asio::ip::udp::socket& socket,
+	AMS_DECL asio::ip::udp::endpoint get_address(asio::ip::udp::socket& socket,
 		const asio::ip::udp::endpoint& endpoint,
-		const std::chrono::system_clock::duration& timeout, error_code& ec)
-	{
-		return detail::get_address_impl(socket, endpoint, timeout, ec);
-	}
+		const std::chrono::system_clock::duration& timeout, error_code& ec);
 
 #if _WIN32
 	/// @brief Get the IP address from a STUN server. Preserves the socket's non-blocking
@@ -54,13 +155,69 @@ namespace asio_miniSTUN
 	/// @param timeout The socket timeout
 	/// @param token The completion token
 	/// @return The deduced address from STUN
-	asio::ip::udp::endpoint get_address(int socket,
+	AMS_DECL asio::ip::udp::endpoint get_address(int socket,
 		const asio::ip::udp::endpoint& endpoint,
-		const std::chrono::system_clock::duration& timeout, error_code& ec)
-	{
-		return detail::get_address_impl(socket, endpoint, timeout, ec);
-	}
+		const std::chrono::system_clock::duration& timeout, error_code& ec);
+#endif
+
+	/// @return A random transaction ID
+	AMS_DECL transaction_id make_transaction_id();
+
+	/// @brief Creates a binding request for sending requests in bulk. Keep the transaction
+	/// ID in the pending set passed to validate_responses until it is answered
+	/// @param id The transaction ID
+	/// @return The binding request
+	AMS_DECL request make_request(const transaction_id& id) noexcept;
+
+	/// @brief Validates and decodes a batch of received responses. A response is valid if
+	/// it is a full-sized binding success response carrying the magic cookie, a pending
+	/// transaction ID and an IPv4 XOR-MAPPED-ADDRESS. Uses AVX2 or SSE2 when the CPU supports them
+	/// @param responses The received responses
+	/// @param sizes The number of bytes received for each response
+	/// @param pending The transaction IDs of the outstanding requests, sorted in ascending order
+	/// @param endpoints The decoded endpoint for each response, or nullopt if it is invalid
+	/// @param matches The index in pending of the transaction ID each response answers, or
+	/// pending.size() if it is invalid
+	/// @return The number of valid responses. Only the common length of responses, sizes,
+	/// endpoints and matches is processed
+	AMS_DECL size_t validate_responses(std::span<const response> responses,
+		std::span<const size_t> sizes, std::span<const transaction_id> pending,
+		std::span<std::optional<asio::ip::udp::endpoint>> endpoints,
+		std::span<size_t> matches) noexcept;
+
+#ifdef AMS_SEPARATE_COMPILATION
+	// common completion tokens are instantiated once in the asio-ministun library
+	extern template get_address_result_t<get_address_handler>
+		async_get_address<get_address_handler>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, get_address_handler&&);
+	extern template get_address_result_t<get_address_handler>
+		async_get_address<get_address_handler>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, redirect_cache&, get_address_handler&&);
+	extern template get_address_result_t<const get_address_handler&>
+		async_get_address<const get_address_handler&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, const get_address_handler&);
+	extern template get_address_result_t<const get_address_handler&>
+		async_get_address<const get_address_handler&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, redirect_cache&, const get_address_handler&);
+	extern template get_address_result_t<const asio::use_future_t<>&>
+		async_get_address<const asio::use_future_t<>&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, const asio::use_future_t<>&);
+	extern template get_address_result_t<const asio::use_future_t<>&>
+		async_get_address<const asio::use_future_t<>&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, redirect_cache&, const asio::use_future_t<>&);
+#ifdef AMS_HAS_CO_AWAIT
+	extern template get_address_result_t<const asio::use_awaitable_t<>&>
+		async_get_address<const asio::use_awaitable_t<>&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, const asio::use_awaitable_t<>&);
+	extern template get_address_result_t<const asio::use_awaitable_t<>&>
+		async_get_address<const asio::use_awaitable_t<>&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, redirect_cache&, const asio::use_awaitable_t<>&);
+#endif
 #endif
 }
 
-#endif
\ No newline at end of file
+#ifdef AMS_HEADER_ONLY
+#include <asio-ministun/impl/asio-ministun.ipp>
+#endif
+
+#endif
@@ -0,0 +1,40 @@
+/// @file batch.hpp
+/// @brief Bulk validation of received XOR-MAPPED-ADDRESS responses
+
+#ifndef AMS_DETAIL_BATCH_H_
+#define AMS_DETAIL_BATCH_H_
+
+// AMS includes
+#include <asio-ministun/detail/common.hpp>
+#include <asio-ministun/detail/header.hpp>
+#include <asio-ministun/detail/xor_mapped_address.hpp>
+
+// STL includes
+#include <cstddef>
+#include <optional>
+#include <span>
+
+namespace asio_miniSTUN::detail
+{
+	/// @brief Validates and decodes a batch of received responses. A response is valid if
+	/// it is a full-sized binding success response carrying the magic cookie, a pending
+	/// transaction ID and an IPv4 XOR-MAPPED-ADDRESS. Uses AVX2 or SSE2 when the CPU supports them
+	/// @param responses The received responses
+	/// @param sizes The number of bytes received for each response
+	/// @param pending The transaction IDs of the outstanding requests, sorted in ascending order
+	/// @param endpoints The decoded endpoint for each response, or nullopt if it is invalid
+	/// @param matches The index in pending of the transaction ID each response answers, or
+	/// pending.size() if it is invalid
+	/// @return The number of valid responses. Only the common length of responses, sizes,
+	/// endpoints and matches is processed
+	AMS_DECL size_t validate_responses_impl(std::span<const xor_mapped_address> responses,
+		std::span<const size_t> sizes, std::span<const header::transaction_id_type> pending,
+		std::span<std::optional<asio::ip::udp::endpoint>> endpoints,
+		std::span<size_t> matches) noexcept;
+}
+
+#ifdef AMS_HEADER_ONLY
+#include <asio-ministun/detail/impl/batch.ipp>
+#endif
+
+#endif
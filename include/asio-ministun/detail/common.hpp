@@ -4,30 +4,58 @@
 #ifndef AMS_DETAIL_COMMON_H_
 #define AMS_DETAIL_COMMON_H_
 
+// AMS_SEPARATE_COMPILATION builds non-template code once in the asio-ministun
+// library instead of in every translation unit that includes it
+#ifdef AMS_SEPARATE_COMPILATION
+#define AMS_DECL
+#else
+#define AMS_HEADER_ONLY 1
+#define AMS_DECL inline
+#endif
+
+#ifdef AMS_USE_BOOST
+#include <boost/asio/version.hpp>
+#ifdef BOOST_ASIO_HAS_CO_AWAIT
+#define AMS_HAS_CO_AWAIT 1
+#endif
+// per-operation cancellation arrived in asio 1.19
+#if BOOST_ASIO_VERSION >= 101900
+#define AMS_HAS_CANCELLATION 1
+#endif
+#else
+#include <asio/version.hpp>
+#ifdef ASIO_HAS_CO_AWAIT
+#define AMS_HAS_CO_AWAIT 1
+#endif
+// per-operation cancellation arrived in asio 1.19
+#if ASIO_VERSION >= 101900
+#define AMS_HAS_CANCELLATION 1
+#endif
+#endif
+
 namespace asio_miniSTUN
 {
 #ifdef AMS_USE_BOOST
 	namespace asio = boost::asio;
 	using errc = boost::system::errc::errc_t;
+	using error_category = boost::system::error_category;
 	using error_code = boost::system::error_code;
 	using system_error = boost::system::system_error;
 #else
 	namespace asio = ::asio;
 	using std::errc;
+	using error_category = std::error_category;
 	using error_code = asio::error_code;
 	using system_error = asio::system_error;
 #endif
 	/// @brief Creates error code value for errc enum e
 	/// @param e The error code enum to create error for
 	/// @return The error code
-	error_code make_error_code(errc e) noexcept
-	{
-#ifdef AMS_USE_BOOST
-		return boost::system::make_error_code(e);
-#else
-		return std::make_error_code(e);
-#endif
-	}
+	AMS_DECL error_code make_error_code(errc e) noexcept;
 }
 
+#ifdef AMS_HEADER_ONLY
+#include <asio-ministun/detail/impl/common.ipp>
+#endif
+
 #endif
\ No newline at end of file
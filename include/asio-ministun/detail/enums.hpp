@@ -35,6 +35,14 @@ namespace asio_miniSTUN::detail
 		realm = 0x0014,
 		none = 0x0015,
 		xor_mapped_address = 0x0020,
+		alternate_server = 0x8023,
+	};
+
+	/// @brief The address family of a mapped address
+	enum class address_family : uint8_t
+	{
+		ipv4 = 0x01,
+		ipv6 = 0x02,
 	};
 }
 
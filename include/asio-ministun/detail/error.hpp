@@ -0,0 +1,49 @@
+/// @file error.hpp
+/// @brief STUN error codes
+
+#ifndef AMS_DETAIL_ERROR_H_
+#define AMS_DETAIL_ERROR_H_
+
+// AMS includes
+#include <asio-ministun/detail/common.hpp>
+
+// STL includes
+#include <system_error>
+#include <type_traits>
+
+namespace asio_miniSTUN
+{
+	/// @brief The RFC5389 ERROR-CODE values. Any other code a server returns is surfaced
+	/// with the same value in stun_category
+	enum class stun_error
+	{
+		try_alternate = 300,
+		bad_request = 400,
+		unauthorized = 401,
+		unknown_attribute = 420,
+		stale_nonce = 438,
+		server_error = 500,
+	};
+
+	/// @return The category of errors returned by STUN servers
+	AMS_DECL const error_category& stun_category() noexcept;
+
+	/// @brief Creates error code value for stun_error enum e
+	/// @param e The error code enum to create error for
+	/// @return The error code
+	AMS_DECL error_code make_error_code(stun_error e) noexcept;
+}
+
+#ifdef AMS_USE_BOOST
+template<>
+struct boost::system::is_error_code_enum<asio_miniSTUN::stun_error> : std::true_type {};
+#else
+template<>
+struct std::is_error_code_enum<asio_miniSTUN::stun_error> : std::true_type {};
+#endif
+
+#ifdef AMS_HEADER_ONLY
+#include <asio-ministun/detail/impl/error.ipp>
+#endif
+
+#endif
@@ -0,0 +1,69 @@
+/// @file error_response.hpp
+/// @brief The RFC5389 STUN error response
+
+#ifndef AMS_DETAIL_ERROR_RESPONSE_H_
+#define AMS_DETAIL_ERROR_RESPONSE_H_
+
+// AMS includes
+#include <asio-ministun/detail/common.hpp>
+#include <asio-ministun/detail/error.hpp>
+
+// STL includes
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace asio_miniSTUN::detail
+{
+	/// @brief A parsed STUN error response
+	class error_response
+	{
+	public:
+		error_response() = default;
+		/// @param code The ERROR-CODE value
+		/// @param reason The ERROR-CODE reason phrase
+		/// @param unknown_attributes The UNKNOWN-ATTRIBUTES types
+		/// @param alternate_server The ALTERNATE-SERVER address
+		error_response(uint16_t code, std::string reason, std::vector<uint16_t> unknown_attributes,
+			std::optional<asio::ip::udp::endpoint> alternate_server) noexcept :
+			_code(code), _reason(std::move(reason)),
+			_unknown_attributes(std::move(unknown_attributes)),
+			_alternate_server(std::move(alternate_server)) {}
+
+		/// @return The ERROR-CODE value
+		uint16_t code() const noexcept { return _code; }
+
+		/// @return The ERROR-CODE as an error code in stun_category
+		error_code to_error_code() const noexcept { return error_code(_code, stun_category()); }
+
+		/// @return The ERROR-CODE reason phrase
+		const std::string& reason() const noexcept { return _reason; }
+
+		/// @return The attribute types the server did not understand
+		const std::vector<uint16_t>& unknown_attributes() const noexcept { return _unknown_attributes; }
+
+		/// @return The ALTERNATE-SERVER address, if the server sent one
+		const std::optional<asio::ip::udp::endpoint>& alternate_server() const noexcept { return _alternate_server; }
+	private:
+		uint16_t _code = 0;
+		std::string _reason;
+		std::vector<uint16_t> _unknown_attributes;
+		std::optional<asio::ip::udp::endpoint> _alternate_server;
+	};
+
+	/// @brief Parses the ERROR-CODE, UNKNOWN-ATTRIBUTES and ALTERNATE-SERVER attributes
+	/// of an error response
+	/// @param datagram The received datagram
+	/// @return The error response, or nullopt if the datagram is not a well-formed error
+	/// response with an ERROR-CODE between 300 and 699
+	AMS_DECL std::optional<error_response> parse_error_response(std::span<const uint8_t> datagram);
+}
+
+#ifdef AMS_HEADER_ONLY
+#include <asio-ministun/detail/impl/error_response.ipp>
+#endif
+
+#endif
@@ -18,22 +18,33 @@ namespace asio_miniSTUN::detail
 	/// @brief The header of a STUN message
 	class header
 	{
+	public:
+		/// @brief The magic cookie in host byte order
+		constexpr static uint32_t magic_cookie = 0x2112A442;
+		/// @brief The transaction ID type
+		using transaction_id_type = std::array<uint8_t, sizeof(uint64_t) + sizeof(uint32_t)>;
 	private:
-		constexpr static uint32_t COOKIE = to_net(0x2112A442);
+		constexpr static uint32_t COOKIE = to_net(magic_cookie);
 	public:
 		header() = default;
 		/// @param msg_type The type of message
-		header(message_class msg_type) noexcept : _length(0), _cookie(COOKIE) 
+		header(message_class msg_type) noexcept : header(msg_type, transaction_id_type{}) {}
+		/// @param msg_type The type of message
+		/// @param transaction_id The transaction ID
+		header(message_class msg_type, const transaction_id_type& transaction_id) noexcept :
+			_length(0), _cookie(COOKIE), _transaction_id(transaction_id)
 		{
 			// binding message
 			_type = to_net<uint16_t>((static_cast<uint16_t>(msg_type) & 0b01) << 4 |
 				(static_cast<uint16_t>(msg_type) & 0b10) << 7 | 1);
-			std::fill(_transaction_id.begin(), _transaction_id.end(), 0);
 		}
 
 		/// @return The cookie used with the STUN response
 		uint32_t cookie() const noexcept { return from_net(_cookie); }
 
+		/// @return The transaction ID
+		const transaction_id_type& transaction_id() const noexcept { return _transaction_id; }
+
 		/// @return The size of the header
 		constexpr size_t size() const noexcept
 		{
@@ -76,8 +87,15 @@ namespace asio_miniSTUN::detail
 		uint16_t _type;
 		uint16_t _length;
 		uint32_t _cookie;
-		std::array<uint8_t, sizeof(uint64_t) + sizeof(uint32_t)> _transaction_id;
+		transaction_id_type _transaction_id;
 	};
+
+	/// @return A random transaction ID
+	AMS_DECL header::transaction_id_type random_transaction_id();
 }
 
+#ifdef AMS_HEADER_ONLY
+#include <asio-ministun/detail/impl/header.ipp>
+#endif
+
 #endif
\ No newline at end of file
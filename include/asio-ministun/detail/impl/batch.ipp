@@ -0,0 +1,264 @@
+/// @file batch.ipp
+/// @brief Implementation of bulk response validation
+
+#ifndef AMS_DETAIL_IMPL_BATCH_IPP_
+#define AMS_DETAIL_IMPL_BATCH_IPP_
+
+// AMS includes
+#include <asio-ministun/detail/batch.hpp>
+
+// STL includes
+#include <algorithm>
+#include <type_traits>
+
+// every variant is compiled for its own instruction set regardless of the compiler
+// flags, so all translation units share one definition and pick a variant at runtime
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define AMS_BATCH_X86 1
+#if defined(__GNUC__) || defined(__clang__)
+#define AMS_BATCH_TARGET(isa) __attribute__((target(isa)))
+#else
+#define AMS_BATCH_TARGET(isa)
+#endif
+#endif
+
+#ifdef AMS_BATCH_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace asio_miniSTUN::detail
+{
+	// the vectorized paths read responses as raw 32-byte wire images
+	static_assert(std::is_standard_layout_v<xor_mapped_address> &&
+		sizeof(xor_mapped_address) == 32, "xor_mapped_address must match its wire layout");
+
+	/// @param response The response
+	/// @param size The number of bytes received
+	/// @return The decoded endpoint, or nullopt if the response is invalid regardless of its
+	/// transaction ID
+	inline std::optional<asio::ip::udp::endpoint> validate_response(
+		const xor_mapped_address& response, size_t size) noexcept
+	{
+		if (size != response.size() ||
+			response.headers().cookie() != header::magic_cookie ||
+			response.headers().type() != message_class::response_success ||
+			response.attribute().type() != message_type::xor_mapped_address ||
+			response.family() != address_family::ipv4)
+			return std::nullopt;
+		return asio::ip::udp::endpoint(response.addr(), response.port());
+	}
+
+	/// @param id The transaction ID of a response
+	/// @param pending The sorted pending transaction IDs
+	/// @param count The number of pending transaction IDs
+	/// @return The index of the pending transaction ID, or count if it is not pending
+	inline size_t find_pending(const header::transaction_id_type& id,
+		const header::transaction_id_type* pending, size_t count) noexcept
+	{
+		const auto* it = std::lower_bound(pending, pending + count, id);
+		return it != pending + count && *it == id ? static_cast<size_t>(it - pending) : count;
+	}
+
+	namespace scalar
+	{
+		/// @brief Validates responses one field at a time
+		inline size_t validate_responses(const xor_mapped_address* responses, const size_t* sizes,
+			const header::transaction_id_type* pending, size_t pending_count,
+			std::optional<asio::ip::udp::endpoint>* endpoints, size_t* matches, size_t count) noexcept
+		{
+			size_t valid = 0;
+			for (size_t i = 0; i < count; ++i)
+			{
+				endpoints[i] = validate_response(responses[i], sizes[i]);
+				matches[i] = endpoints[i].has_value() ? find_pending(
+					responses[i].headers().transaction_id(), pending, pending_count) : pending_count;
+				if (matches[i] == pending_count)
+				{
+					endpoints[i].reset();
+					continue;
+				}
+				++valid;
+			}
+			return valid;
+		}
+	}
+
+#ifdef AMS_BATCH_X86
+	namespace sse2
+	{
+		/// @brief The checked bits of the first 16 bytes: the class bits of the type and
+		/// the cookie. The transaction ID is looked up in the pending set afterwards
+		AMS_BATCH_TARGET("sse2") inline __m128i mask_lo() noexcept
+		{
+			return _mm_setr_epi8(0x01, 0x10, 0, 0, -1, -1, -1, -1,
+				0, 0, 0, 0, 0, 0, 0, 0);
+		}
+
+		/// @brief The checked bits of the last 16 bytes: the attribute type and the address
+		/// family
+		AMS_BATCH_TARGET("sse2") inline __m128i mask_hi() noexcept
+		{
+			return _mm_setr_epi8(0, 0, 0, 0, -1, -1, 0, 0,
+				0, -1, 0, 0, 0, 0, 0, 0);
+		}
+
+		/// @brief The expected first 16 bytes
+		AMS_BATCH_TARGET("sse2") inline __m128i expected_lo() noexcept
+		{
+			return _mm_setr_epi8(0x01, 0x00, 0, 0, 0x21, 0x12, static_cast<char>(0xA4), 0x42,
+				0, 0, 0, 0, 0, 0, 0, 0);
+		}
+
+		/// @brief The expected last 16 bytes
+		AMS_BATCH_TARGET("sse2") inline __m128i expected_hi() noexcept
+		{
+			return _mm_setr_epi8(0, 0, 0, 0, 0x00, 0x20, 0, 0,
+				0, static_cast<char>(address_family::ipv4), 0, 0, 0, 0, 0, 0);
+		}
+
+		/// @brief Validates each response with two masked 16-byte compares
+		AMS_BATCH_TARGET("sse2") inline size_t validate_responses(
+			const xor_mapped_address* responses, const size_t* sizes,
+			const header::transaction_id_type* pending, size_t pending_count,
+			std::optional<asio::ip::udp::endpoint>* endpoints, size_t* matches, size_t count) noexcept
+		{
+			const auto* raw = reinterpret_cast<const uint8_t*>(responses);
+			const __m128i mask_lo = sse2::mask_lo();
+			const __m128i mask_hi = sse2::mask_hi();
+			const __m128i expected_lo = sse2::expected_lo();
+			const __m128i expected_hi = sse2::expected_hi();
+			size_t valid = 0;
+			for (size_t i = 0; i < count; ++i, raw += sizeof(xor_mapped_address))
+			{
+				const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw));
+				const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + 16));
+				const __m128i diff = _mm_or_si128(
+					_mm_and_si128(mask_lo, _mm_xor_si128(lo, expected_lo)),
+					_mm_and_si128(mask_hi, _mm_xor_si128(hi, expected_hi)));
+				matches[i] = _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) == 0xffff &&
+					sizes[i] == sizeof(xor_mapped_address) ? find_pending(
+						responses[i].headers().transaction_id(), pending, pending_count) : pending_count;
+				if (matches[i] == pending_count)
+				{
+					endpoints[i].reset();
+					continue;
+				}
+				endpoints[i].emplace(responses[i].addr(), responses[i].port());
+				++valid;
+			}
+			return valid;
+		}
+	}
+
+	namespace avx2
+	{
+		/// @brief Decodes the XOR-MAPPED-ADDRESS from the last 16 bytes of a response by
+		/// unmasking with the cookie and byte-swapping the port and address in one shuffle
+		/// @param hi The last 16 bytes of the response
+		/// @return The decoded endpoint
+		AMS_BATCH_TARGET("avx2") inline asio::ip::udp::endpoint decode(__m128i hi) noexcept
+		{
+			const __m128i cookie = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0,
+				0, 0, 0x21, 0x12, 0x21, 0x12, static_cast<char>(0xA4), 0x42);
+			// bytes 0-3 are the host address, bytes 4-5 the host port
+			const __m128i swap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1);
+			const __m128i decoded = _mm_shuffle_epi8(_mm_xor_si128(hi, cookie), swap);
+			return asio::ip::udp::endpoint(
+				asio::ip::address_v4(static_cast<uint32_t>(_mm_cvtsi128_si32(decoded))),
+				static_cast<uint16_t>(_mm_extract_epi16(decoded, 2)));
+		}
+
+		/// @brief Validates each response with one masked 32-byte compare
+		AMS_BATCH_TARGET("avx2") inline size_t validate_responses(
+			const xor_mapped_address* responses, const size_t* sizes,
+			const header::transaction_id_type* pending, size_t pending_count,
+			std::optional<asio::ip::udp::endpoint>* endpoints, size_t* matches, size_t count) noexcept
+		{
+			const auto* raw = reinterpret_cast<const uint8_t*>(responses);
+			const __m256i mask = _mm256_set_m128i(sse2::mask_hi(), sse2::mask_lo());
+			const __m256i expected = _mm256_set_m128i(sse2::expected_hi(), sse2::expected_lo());
+			size_t valid = 0;
+			for (size_t i = 0; i < count; ++i, raw += sizeof(xor_mapped_address))
+			{
+				const __m256i packet = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(raw));
+				const __m256i diff = _mm256_and_si256(mask, _mm256_xor_si256(packet, expected));
+				matches[i] = _mm256_movemask_epi8(_mm256_cmpeq_epi8(diff, _mm256_setzero_si256())) == -1 &&
+					sizes[i] == sizeof(xor_mapped_address) ? find_pending(
+						responses[i].headers().transaction_id(), pending, pending_count) : pending_count;
+				if (matches[i] == pending_count)
+				{
+					endpoints[i].reset();
+					continue;
+				}
+				endpoints[i] = decode(_mm256_extracti128_si256(packet, 1));
+				++valid;
+			}
+			return valid;
+		}
+	}
+
+	/// @return Whether the CPU and OS support AVX2
+	inline bool cpu_supports_avx2() noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_cpu_supports("avx2");
+#else
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		// the OS must save the AVX registers
+		__cpuid(info, 1);
+		constexpr int osxsave_avx = (1 << 27) | (1 << 28);
+		if ((info[2] & osxsave_avx) != osxsave_avx || (_xgetbv(0) & 0b110) != 0b110)
+			return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#endif
+	}
+
+	/// @return Whether the CPU supports SSE2
+	inline bool cpu_supports_sse2() noexcept
+	{
+#if defined(__x86_64__) || defined(_M_X64)
+		return true;
+#elif defined(__GNUC__) || defined(__clang__)
+		return __builtin_cpu_supports("sse2");
+#else
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+#endif
+	}
+#endif
+
+	AMS_DECL size_t validate_responses_impl(std::span<const xor_mapped_address> responses,
+		std::span<const size_t> sizes, std::span<const header::transaction_id_type> pending,
+		std::span<std::optional<asio::ip::udp::endpoint>> endpoints,
+		std::span<size_t> matches) noexcept
+	{
+		const size_t count = std::min({ responses.size(), sizes.size(),
+			endpoints.size(), matches.size() });
+#ifdef AMS_BATCH_X86
+		static const bool has_avx2 = cpu_supports_avx2();
+		static const bool has_sse2 = cpu_supports_sse2();
+		if (has_avx2)
+			return avx2::validate_responses(responses.data(), sizes.data(),
+				pending.data(), pending.size(), endpoints.data(), matches.data(), count);
+		if (has_sse2)
+			return sse2::validate_responses(responses.data(), sizes.data(),
+				pending.data(), pending.size(), endpoints.data(), matches.data(), count);
+#endif
+		return scalar::validate_responses(responses.data(), sizes.data(),
+			pending.data(), pending.size(), endpoints.data(), matches.data(), count);
+	}
+}
+
+#undef AMS_BATCH_TARGET
+#undef AMS_BATCH_X86
+
+#endif
@@ -0,0 +1,22 @@
+/// @file common.ipp
+/// @brief Common utilities implementation
+
+#ifndef AMS_DETAIL_IMPL_COMMON_IPP_
+#define AMS_DETAIL_IMPL_COMMON_IPP_
+
+// AMS includes
+#include <asio-ministun/detail/common.hpp>
+
+namespace asio_miniSTUN
+{
+	AMS_DECL error_code make_error_code(errc e) noexcept
+	{
+#ifdef AMS_USE_BOOST
+		return boost::system::errc::make_error_code(e);
+#else
+		return std::make_error_code(e);
+#endif
+	}
+}
+
+#endif
@@ -0,0 +1,51 @@
+/// @file error.ipp
+/// @brief STUN error codes implementation
+
+#ifndef AMS_DETAIL_IMPL_ERROR_IPP_
+#define AMS_DETAIL_IMPL_ERROR_IPP_
+
+// AMS includes
+#include <asio-ministun/detail/error.hpp>
+
+// STL includes
+#include <string>
+
+namespace asio_miniSTUN
+{
+	namespace detail
+	{
+		/// @brief The category of errors returned by STUN servers
+		class stun_category_impl : public error_category
+		{
+		public:
+			const char* name() const noexcept override { return "asio-ministun.stun"; }
+
+			std::string message(int value) const override
+			{
+				switch (static_cast<stun_error>(value))
+				{
+				case stun_error::try_alternate: return "Try alternate server";
+				case stun_error::bad_request: return "Bad request";
+				case stun_error::unauthorized: return "Unauthorized";
+				case stun_error::unknown_attribute: return "Unknown attribute";
+				case stun_error::stale_nonce: return "Stale nonce";
+				case stun_error::server_error: return "Server error";
+				}
+				return "STUN error " + std::to_string(value);
+			}
+		};
+	}
+
+	AMS_DECL const error_category& stun_category() noexcept
+	{
+		static const detail::stun_category_impl instance;
+		return instance;
+	}
+
+	AMS_DECL error_code make_error_code(stun_error e) noexcept
+	{
+		return error_code(static_cast<int>(e), stun_category());
+	}
+}
+
+#endif
@@ -0,0 +1,105 @@
+/// @file error_response.ipp
+/// @brief Implementation of parsing STUN error responses
+
+#ifndef AMS_DETAIL_IMPL_ERROR_RESPONSE_IPP_
+#define AMS_DETAIL_IMPL_ERROR_RESPONSE_IPP_
+
+// AMS includes
+#include <asio-ministun/detail/enums.hpp>
+#include <asio-ministun/detail/error_response.hpp>
+#include <asio-ministun/detail/header.hpp>
+
+// STL includes
+#include <array>
+#include <algorithm>
+
+namespace asio_miniSTUN::detail
+{
+	AMS_DECL std::optional<error_response> parse_error_response(std::span<const uint8_t> datagram)
+	{
+		constexpr size_t header_size = 20;
+		constexpr size_t attribute_header_size = 4;
+		auto const read16 = [&](size_t offset)
+		{
+			return static_cast<uint16_t>(datagram[offset] << 8 | datagram[offset + 1]);
+		};
+		auto const read32 = [&](size_t offset)
+		{
+			return static_cast<uint32_t>(read16(offset)) << 16 | read16(offset + 2);
+		};
+		if (datagram.size() < header_size)
+			return std::nullopt;
+		// check the class and cookie
+		const uint16_t type = read16(0);
+		if (static_cast<message_class>(((type >> 4) & 0b01) | ((type >> 7) & 0b10)) !=
+			message_class::response_error ||
+			read32(4) != header::magic_cookie)
+			return std::nullopt;
+		// attributes are padded to 4 bytes
+		const size_t length = read16(2);
+		if (length % 4 != 0 || header_size + length > datagram.size())
+			return std::nullopt;
+		const size_t end = header_size + length;
+		std::optional<uint16_t> code;
+		std::string reason;
+		std::vector<uint16_t> unknown_attributes;
+		std::optional<asio::ip::udp::endpoint> alternate_server;
+		for (size_t offset = header_size; offset + attribute_header_size <= end;)
+		{
+			const uint16_t attribute_type = read16(offset);
+			const size_t attribute_length = read16(offset + 2);
+			const size_t value = offset + attribute_header_size;
+			if (value + attribute_length > end)
+				return std::nullopt;
+			switch (static_cast<message_type>(attribute_type))
+			{
+			case message_type::error_code:
+			{
+				if (attribute_length < 4)
+					return std::nullopt;
+				// the hundreds digit is in the low 3 bits of the class byte. RFC5389
+				// 15.6 limits the class to 3-6 and the number to 0-99
+				const uint8_t code_class = datagram[value + 2] & 0b111;
+				const uint8_t number = datagram[value + 3];
+				if (code_class < 3 || code_class > 6 || number >= 100)
+					return std::nullopt;
+				code = static_cast<uint16_t>(code_class * 100 + number);
+				reason.assign(reinterpret_cast<const char*>(datagram.data() + value + 4),
+					attribute_length - 4);
+				break;
+			}
+			case message_type::unknown_attributes:
+			{
+				for (size_t i = 0; i + 1 < attribute_length; i += 2)
+					unknown_attributes.push_back(read16(value + i));
+				break;
+			}
+			case message_type::alternate_server:
+			{
+				if (attribute_length < 4)
+					return std::nullopt;
+				const auto family = static_cast<address_family>(datagram[value + 1]);
+				const uint16_t port = read16(value + 2);
+				if (family == address_family::ipv4 && attribute_length >= 8)
+					alternate_server.emplace(asio::ip::address_v4(read32(value + 4)), port);
+				else if (family == address_family::ipv6 && attribute_length >= 20)
+				{
+					asio::ip::address_v6::bytes_type bytes;
+					std::copy_n(datagram.begin() + value + 4, bytes.size(), bytes.begin());
+					alternate_server.emplace(asio::ip::address_v6(bytes), port);
+				}
+				break;
+			}
+			default:
+				break;
+			}
+			offset = value + ((attribute_length + 3) & ~size_t(3));
+		}
+		if (!code.has_value())
+			return std::nullopt;
+		return error_response(*code, std::move(reason),
+			std::move(unknown_attributes), std::move(alternate_server));
+	}
+}
+
+#endif
@@ -0,0 +1,35 @@
+/// @file header.ipp
+/// @brief Implementation of generating transaction IDs
+
+#ifndef AMS_DETAIL_IMPL_HEADER_IPP_
+#define AMS_DETAIL_IMPL_HEADER_IPP_
+
+// AMS includes
+#include <asio-ministun/detail/header.hpp>
+
+// STL includes
+#include <cstring>
+#include <random>
+
+namespace asio_miniSTUN::detail
+{
+	AMS_DECL header::transaction_id_type random_transaction_id()
+	{
+		// seed once per thread so generating IDs stays cheap
+		thread_local std::mt19937_64 engine = []
+		{
+			std::random_device device;
+			std::seed_seq seed{ device(), device(), device(), device(),
+				device(), device(), device(), device() };
+			return std::mt19937_64(seed);
+		}();
+		const uint64_t head = engine();
+		const auto tail = static_cast<uint32_t>(engine());
+		header::transaction_id_type id;
+		std::memcpy(id.data(), &head, sizeof(head));
+		std::memcpy(id.data() + sizeof(head), &tail, sizeof(tail));
+		return id;
+	}
+}
+
+#endif
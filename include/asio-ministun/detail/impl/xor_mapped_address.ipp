@@ -0,0 +1,160 @@
+/// @file xor_mapped_address.ipp
+/// @brief Implementation of synchronously fetching XOR-MAPPED-ADDRESS
+
+#ifndef AMS_DETAIL_IMPL_XOR_MAPPED_ADDRESS_IPP_
+#define AMS_DETAIL_IMPL_XOR_MAPPED_ADDRESS_IPP_
+
+// AMS includes
+#include <asio-ministun/detail/xor_mapped_address.hpp>
+
+#if _WIN32
+// STL includes
+#include <ranges>
+#include <vector>
+#endif
+
+namespace asio_miniSTUN::detail
+{
+	AMS_DECL asio::ip::udp::endpoint get_address_impl(asio::ip::udp::socket& socket,
+		const asio::ip::udp::endpoint& endpoint, 
+		const std::chrono::system_clock::duration& timeout, error_code& ec)
+	{
+		// ensure the socket is not already connected
+		if (socket.remote_endpoint(ec); !ec)
+			return {};
+		bool const non_blocking = socket.native_non_blocking();
+		// get old timeout
+		asio::detail::socket_option::integer<SOL_SOCKET, SO_RCVTIMEO> rcv_timeout;
+		if (socket.get_option(rcv_timeout, ec))
+			return {};
+		// set the new timeout
+		if (socket.set_option(asio::detail::socket_option::integer<SOL_SOCKET, SO_RCVTIMEO>(
+			static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count())), ec))
+			return {};
+		header const request(message_class::request);
+		xor_mapped_address response;
+		// disable non-blocking
+		socket.native_non_blocking(false);
+		// send the request
+		if (socket.send_to(request.to_const_buffers(), endpoint, 0, ec); !ec)
+		{
+			// receive the response until we get it from the STUN server
+			for (asio::ip::udp::endpoint recv_endpoint; recv_endpoint != endpoint;)
+			{
+				if (socket.receive_from(response.to_buffers(), recv_endpoint, 0, ec); ec)
+					break;
+			}
+		}
+		// return non-blocking and recv timeout
+		if (socket.native_non_blocking(non_blocking, ec) ||
+			socket.set_option(rcv_timeout, ec))
+			return {};
+		return asio::ip::udp::endpoint(response.addr(), response.port());
+	}
+
+#if _WIN32
+	AMS_DECL asio::ip::udp::endpoint get_address_impl(int socket,
+		const asio::ip::udp::endpoint& endpoint,
+		const std::chrono::system_clock::duration& timeout, error_code& ec)
+	{
+		// get old timeout
+		int rcv_timeout;
+		int rcv_timeout_len = sizeof(rcv_timeout);
+		if (getsockopt(socket, SOL_SOCKET, SO_RCVTIMEO,
+			reinterpret_cast<char*>(&rcv_timeout), &rcv_timeout_len) != 0)
+		{
+			ec = asio::error_code(GetLastError(), asio::system_category());
+			return {};
+		}
+		header request(message_class::request);
+		// form the buffers
+		auto buffers = collect<std::vector<WSABUF>>(request.to_const_buffers() | 
+			std::ranges::views::transform([](const asio::const_buffer& buf)
+				{
+					return WSABUF {
+						.len = static_cast<ULONG>(buf.size()),
+						.buf = const_cast<char*>(reinterpret_cast<char const*>(buf.data())),
+					};
+				}
+			));
+		// it may be non-blocking, so keep trying until we succeed
+		while (true)
+		{
+			DWORD bytes_sent;
+			int const send_res = WSASendTo(socket, buffers.data(),
+				static_cast<DWORD>(buffers.size()), &bytes_sent, 0,
+				endpoint.data(), sizeof(*endpoint.data()), nullptr,
+				nullptr);
+			if (send_res == 0)
+				break;
+			// we errored, see if it's because non-blocking
+			int const last_error = GetLastError();
+			if (last_error != WSAEWOULDBLOCK)
+			{
+				// error
+				ec = asio::error_code(last_error, asio::system_category());
+				return {};
+			}
+		};
+		// receive the response until we get it from the STUN server.
+		xor_mapped_address response;
+		// form the buffers
+		buffers = collect<std::vector<WSABUF>>(response.to_buffers() |
+			std::ranges::views::transform([](const asio::mutable_buffer& buf)
+				{
+					return WSABUF{
+						.len = static_cast<ULONG>(buf.size()),
+						.buf = reinterpret_cast<char*>(buf.data()),
+					};
+				}
+		));
+		// also keep track of the timeout :))))))
+		auto const start = std::chrono::system_clock::now();
+		while (true)
+		{
+			DWORD bytes_recvd;
+			sockaddr_in recv_addr{};
+			INT recv_len = sizeof(recv_addr);
+			DWORD flags = 0;
+			int const recv_res = WSARecvFrom(socket, buffers.data(),
+				static_cast<DWORD>(buffers.size()), &bytes_recvd, &flags,
+				reinterpret_cast<sockaddr*>(&recv_addr), &recv_len,
+				nullptr, nullptr);
+			if (recv_res == 0)
+			{
+				// ensure it's from the expected address
+				if (ntohl(recv_addr.sin_addr.S_un.S_addr) ==
+					endpoint.address().to_v4().to_uint() &&
+					ntohs(recv_addr.sin_port) == endpoint.port())
+					break;
+				// keep searching
+				continue;
+			}
+			// see if we timed out
+			if ((std::chrono::system_clock::now() - start) >= timeout)
+			{
+				ec = asio_miniSTUN::make_error_code(errc::timed_out);
+				break;
+			}
+			// we errored, see if it's because non-blocking
+			int const last_error = GetLastError();
+			if (last_error != WSAEWOULDBLOCK)
+			{
+				// error
+				ec = asio::error_code(last_error, asio::system_category());
+				return {};
+			}
+		}
+		// return recv timeout
+		if (setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, 
+			reinterpret_cast<char*>(&rcv_timeout), rcv_timeout_len) != 0)
+		{
+			ec = asio::error_code(GetLastError(), asio::system_category());
+			return {};
+		}
+		return asio::ip::udp::endpoint(response.addr(), response.port());
+	}
+#endif
+}
+
+#endif
@@ -0,0 +1,81 @@
+/// @file redirect_cache.hpp
+/// @brief A cache of ALTERNATE-SERVER redirects
+
+#ifndef AMS_DETAIL_REDIRECT_CACHE_H_
+#define AMS_DETAIL_REDIRECT_CACHE_H_
+
+// AMS includes
+#include <asio-ministun/detail/common.hpp>
+
+// STL includes
+#include <chrono>
+#include <map>
+#include <mutex>
+
+namespace asio_miniSTUN::detail
+{
+	/// @brief Caches the ALTERNATE-SERVER each STUN server redirected to, so that later
+	/// requests go straight to the alternate server. Thread-safe
+	class redirect_cache
+	{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		/// @param ttl How long a redirect stays cached
+		explicit redirect_cache(clock::duration ttl = std::chrono::minutes(5)) noexcept :
+			_ttl(ttl) {}
+
+		/// @param server The STUN server endpoint
+		/// @return The cached alternate server, or the server itself if there is none
+		asio::ip::udp::endpoint resolve(const asio::ip::udp::endpoint& server)
+		{
+			std::lock_guard lock(_mutex);
+			const auto it = _entries.find(server);
+			if (it == _entries.end())
+				return server;
+			// drop expired redirects
+			if (clock::now() >= it->second.expiry)
+			{
+				_entries.erase(it);
+				return server;
+			}
+			return it->second.target;
+		}
+
+		/// @brief Caches a redirect, replacing any existing one for the server
+		/// @param server The STUN server endpoint
+		/// @param alternate The alternate server endpoint
+		void insert(const asio::ip::udp::endpoint& server, const asio::ip::udp::endpoint& alternate)
+		{
+			std::lock_guard lock(_mutex);
+			_entries.insert_or_assign(server, entry{ alternate, clock::now() + _ttl });
+		}
+
+		/// @brief Forgets the redirect for a server
+		/// @param server The STUN server endpoint
+		void erase(const asio::ip::udp::endpoint& server)
+		{
+			std::lock_guard lock(_mutex);
+			_entries.erase(server);
+		}
+
+		/// @brief Forgets all redirects
+		void clear()
+		{
+			std::lock_guard lock(_mutex);
+			_entries.clear();
+		}
+	private:
+		struct entry
+		{
+			asio::ip::udp::endpoint target;
+			clock::time_point expiry;
+		};
+
+		std::mutex _mutex;
+		std::map<asio::ip::udp::endpoint, entry> _entries;
+		clock::duration _ttl;
+	};
+}
+
+#endif
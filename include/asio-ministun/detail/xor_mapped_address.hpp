@@ -8,16 +8,21 @@
 #include <asio-ministun/detail/attributes.hpp>
 #include <asio-ministun/detail/common.hpp>
 #include <asio-ministun/detail/enums.hpp>
+#include <asio-ministun/detail/error.hpp>
+#include <asio-ministun/detail/error_response.hpp>
+#include <asio-ministun/detail/header.hpp>
+#include <asio-ministun/detail/redirect_cache.hpp>
 #include <asio-ministun/detail/util.hpp>
 
-#include <iostream>
-#include <ranges>
-
-#ifdef AMS_USE_BOOST
-#include <boost/asio/experimental/awaitable_operators.hpp>
-#else
-#include <asio/experimental/awaitable_operators.hpp>
-#endif
+// STL includes
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
 
 namespace asio_miniSTUN::detail
 {
@@ -36,6 +41,12 @@ namespace asio_miniSTUN::detail
 		/// @return The headers
 		const header& headers() const noexcept { return _header; }
 
+		/// @return The attribute
+		const attributes& attribute() const noexcept { return _attribute; }
+
+		/// @return The address family
+		address_family family() const noexcept { return static_cast<address_family>(_family); }
+
 		/// @return The response port
 		uint16_t port() const noexcept
 		{
@@ -67,92 +78,214 @@ namespace asio_miniSTUN::detail
 		uint32_t _xor_addr;
 	};
 
-	/// @brief Get the IP address from a STUN server. Preserves the socket's non-blocking
-	/// state as long as the operation does not encounter an OS-level error. The socket must
-	/// not be connected
+	/// @brief The largest datagram a response is received into
+	inline constexpr size_t max_datagram_size = 1500;
+
+	/// @brief The most ALTERNATE-SERVER redirects followed by one request
+	inline constexpr size_t max_redirects = 3;
+
+	/// @brief The completion signature of async_get_address_impl
+	using get_address_signature = void(error_code, asio::ip::udp::endpoint);
+
+	/// @brief The composed operation behind async_get_address_impl
+	class get_address_op
+	{
+	public:
+		/// @param socket The socket to use
+		/// @param endpoint The STUN server endpoint
+		/// @param cache The redirect cache to consult and update, or nullptr
+		/// @param error Receives the error response the operation fails with, or nullptr
+		get_address_op(asio::ip::udp::socket& socket, const asio::ip::udp::endpoint& endpoint,
+			redirect_cache* cache, error_response* error) :
+			_socket(socket),
+			_endpoint(endpoint),
+			// go straight to a cached alternate server
+			_target((cache != nullptr) ? cache->resolve(endpoint) : endpoint),
+			_cache(cache),
+			_error(error),
+			// back-up socket traits
+			_non_blocking(socket.native_non_blocking()),
+			// form request and response
+			_request(std::make_unique<header>(message_class::request, random_transaction_id())),
+			_response(std::make_unique<xor_mapped_address>()),
+			_datagram(std::make_unique<std::array<uint8_t, max_datagram_size>>()),
+			_recv_endpoint(std::make_unique<asio::ip::udp::endpoint>()) {}
+
+		/// @brief Runs the next step of the operation
+		/// @tparam Self The intermediate completion handler type
+		/// @param self The intermediate completion handler
+		/// @param ec The result of the last step
+		/// @param bytes_transferred The bytes transferred by the last step
+		template<typename Self>
+		void operator()(Self& self, const error_code& ec = {}, size_t bytes_transferred = 0)
+		{
+			// make sure we don't have any errors
+			if (ec)
+				return complete(self, ec);
+#ifdef AMS_HAS_CANCELLATION
+			// make sure we weren't cancelled between operations
+			if (_state != state::send_request &&
+				self.cancelled() != asio::cancellation_type::none)
+				return complete(self, asio::error::operation_aborted);
+#endif
+			switch (_state)
+			{
+			case state::send_request:
+			{
+#ifdef AMS_HAS_CANCELLATION
+				// the request may already be on the wire, so only terminal and
+				// partial cancellation can be honoured
+				self.reset_cancellation_state(asio::enable_partial_cancellation());
+#endif
+				// set non-blocking
+				error_code ignored;
+				_socket.native_non_blocking(true, ignored);
+				// ensure the socket is not already connected
+				if (_socket.remote_endpoint(ignored); !ignored)
+					return complete(self, asio_miniSTUN::make_error_code(errc::already_connected));
+				_state = state::receive_response;
+				return _socket.async_send_to(_request->to_const_buffers(), _target, std::move(self));
+			}
+			case state::receive_response:
+			{
+				// check sent request
+				if (bytes_transferred != _request->size())
+					return complete(self, asio_miniSTUN::make_error_code(errc::bad_message));
+				_state = state::cleanup;
+				return _socket.async_receive_from(asio::buffer(*_datagram), *_recv_endpoint, std::move(self));
+			}
+			case state::cleanup:
+			{
+				asio::buffer_copy(_response->to_buffers(), asio::buffer(*_datagram, bytes_transferred));
+				// ignore unexpected responses and responses to other requests
+				if (*_recv_endpoint != _target ||
+					bytes_transferred < _response->headers().size() ||
+					_response->headers().transaction_id() != _request->transaction_id())
+					return _socket.async_receive_from(asio::buffer(*_datagram), *_recv_endpoint, std::move(self));
+				// check received response
+				if (_response->headers().type() == message_class::response_error)
+				{
+					std::optional<error_response> error = parse_error_response(
+						std::span<const uint8_t>(_datagram->data(), bytes_transferred));
+					// a zero code would complete as a success
+					if (!error.has_value() || error->code() == 0)
+						return complete(self, asio_miniSTUN::make_error_code(errc::bad_message));
+					// follow the redirect, which must keep the server's address family
+					if (error->code() == static_cast<uint16_t>(stun_error::try_alternate) &&
+						error->alternate_server().has_value() &&
+						error->alternate_server()->protocol() == _endpoint.protocol() &&
+						_redirects < max_redirects)
+					{
+						++_redirects;
+						_target = *error->alternate_server();
+						_state = state::receive_response;
+						return _socket.async_send_to(_request->to_const_buffers(), _target, std::move(self));
+					}
+					const error_code stun_ec = error->to_error_code();
+					if (_error != nullptr)
+						*_error = std::move(*error);
+					return complete(self, stun_ec);
+				}
+				if (bytes_transferred != _response->size() ||
+					_response->headers().type() != message_class::response_success)
+					return complete(self, asio_miniSTUN::make_error_code(errc::bad_message));
+				// call the success handler
+				return complete(self, {}, asio::ip::udp::endpoint(
+					_response->addr(), _response->port()));
+			}
+			}
+		}
+	private:
+		/// @brief Restores the socket's original state, updates the redirect cache and
+		/// completes the operation
+		/// @tparam Self The intermediate completion handler type
+		/// @param self The intermediate completion handler
+		/// @param error The result of the operation
+		/// @param result The deduced address
+		template<typename Self>
+		void complete(Self& self, const error_code& error, asio::ip::udp::endpoint result = {})
+		{
+			if (_cache != nullptr && _target != _endpoint)
+			{
+				// don't keep sending to an alternate server that failed for any reason,
+				// and only cache redirects to alternate servers that answered
+				if (error)
+					_cache->erase(_endpoint);
+				else if (_redirects != 0)
+					_cache->insert(_endpoint, _target);
+			}
+			error_code ignored;
+			_socket.native_non_blocking(_non_blocking, ignored);
+			self.complete(error, std::move(result));
+		}
+
+		enum class state
+		{
+			send_request,
+			receive_response,
+			cleanup,
+		};
+
+		asio::ip::udp::socket& _socket;
+		asio::ip::udp::endpoint _endpoint;
+		asio::ip::udp::endpoint _target;
+		redirect_cache* _cache;
+		error_response* _error;
+		bool _non_blocking;
+		std::unique_ptr<header> _request;
+		std::unique_ptr<xor_mapped_address> _response;
+		std::unique_ptr<std::array<uint8_t, max_datagram_size>> _datagram;
+		std::unique_ptr<asio::ip::udp::endpoint> _recv_endpoint;
+		size_t _redirects = 0;
+		state _state = state::send_request;
+	};
+
+	/// @brief Launches get_address_op when the operation is initiated
+	struct initiate_get_address
+	{
+		/// @tparam Handler The completion handler type
+		/// @param handler The completion handler
+		/// @param socket The socket to use
+		/// @param endpoint The STUN server endpoint
+		/// @param cache The redirect cache to consult and update, or nullptr
+		/// @param error Receives the error response the operation fails with, or nullptr
+		template<typename Handler>
+		void operator()(Handler&& handler, asio::ip::udp::socket* socket,
+			const asio::ip::udp::endpoint& endpoint, redirect_cache* cache,
+			error_response* error) const
+		{
+			asio::async_compose<Handler, get_address_signature>(
+				get_address_op(*socket, endpoint, cache, error), handler, *socket);
+		}
+	};
+
+	/// @brief The initiating function result of async_get_address_impl for a completion token
+	/// @tparam CompletionToken The completion token type
+	template<typename CompletionToken>
+	using get_address_result_t = decltype(asio::async_initiate<CompletionToken, get_address_signature>(
+		std::declval<initiate_get_address>(), std::declval<CompletionToken&>(),
+		std::declval<asio::ip::udp::socket*>(), std::declval<const asio::ip::udp::endpoint&>(),
+		std::declval<redirect_cache*>(), std::declval<error_response*>()));
+
+	/// @brief Get the IP address from a STUN server. Always restores the socket's non-blocking
+	/// state on completion. The socket must not be connected. With asio 1.19 or later,
+	/// supports terminal and partial cancellation through the handler's associated
+	/// cancellation slot. Follows 300 Try Alternate redirects, and surfaces other error
+	/// responses in stun_category
 	/// @tparam CompletionToken The completion token type
 	/// @param socket The socket to use
 	/// @param endpoint The STUN server endpoint
+	/// @param cache The redirect cache to consult and update, or nullptr
+	/// @param error Receives the error response the operation fails with, or nullptr
 	/// @param token The completion token
 	/// @return DEDUCED. Handler must be in the form void(asio::error_code, asio::ip::udp::endpoint)
 	template<typename CompletionToken>
-	auto async_get_address_impl(asio::ip::udp::socket& socket,
-		const asio::ip::udp::endpoint& endpoint, CompletionToken&& token)
+	get_address_result_t<CompletionToken> async_get_address_impl(asio::ip::udp::socket& socket,
+		const asio::ip::udp::endpoint& endpoint, redirect_cache* cache, error_response* error,
+		CompletionToken&& token)
 	{
-		enum class State
-		{
-			SendRequest,
-			ReceiveResponse,
-			Cleanup,
-		};
-		// back-up socket traits
-		error_code ignored;
-		bool non_blocking = socket.native_non_blocking();
-		// form request and response
-		auto request = std::make_unique<header>(message_class::request);
-		auto response = std::make_unique<xor_mapped_address>();
-		auto recv_endpoint = std::make_unique<asio::ip::udp::endpoint>();
-		return asio::async_compose<CompletionToken,
-			void(asio::error_code, asio::ip::udp::endpoint)>(
-				[
-					&socket,
-					endpoint,
-					non_blocking,
-					request = std::move(request),
-					response = std::move(response),
-					recv_endpoint = std::move(recv_endpoint),
-					state = State::SendRequest
-				]
-				(
-					auto& self,
-					const error_code& ec = {},
-					size_t bytes_transferred = 0
-				) mutable {
-					// make sure we don't have any errors
-					if (ec)
-						return self.complete(ec, asio::ip::udp::endpoint());
-					switch (state)
-					{
-					case State::SendRequest:
-					{
-						// set non-blocking
-						error_code ignored;
-						socket.native_non_blocking(true);
-						// ensure the socket is not already connected
-						if (socket.remote_endpoint(ignored); !ignored)
-							return self.complete(asio_miniSTUN::make_error_code(
-								errc::already_connected), asio::ip::udp::endpoint());
-						state = State::ReceiveResponse;
-						return socket.async_send_to(request->to_const_buffers(), endpoint, std::move(self));
-					}
-					case State::ReceiveResponse:
-					{
-						// check sent request
-						if (bytes_transferred != request->size())
-							return self.complete(asio_miniSTUN::make_error_code(errc::bad_message),
-								asio::ip::udp::endpoint());
-						state = State::Cleanup;
-						return socket.async_receive_from(response->to_buffers(), *recv_endpoint, std::move(self));
-					}
-					case State::Cleanup:
-					{
-						// ignore unexpected responses
-						if (*recv_endpoint != endpoint)
-							return socket.async_receive_from(response->to_buffers(), *recv_endpoint, std::move(self));
-						// check received response
-						if (bytes_transferred != response->size() ||
-							response->headers().type() != message_class::response_success)
-							return self.complete(asio_miniSTUN::make_error_code(errc::bad_message),
-								asio::ip::udp::endpoint());
-						// restore non-blocking
-						socket.native_non_blocking(non_blocking);
-						// call the success handler
-						return self.complete({}, asio::ip::udp::endpoint(
-							response->addr(), response->port()));
-					}
-					}
-				},
-			token, socket);
+		return asio::async_initiate<CompletionToken, get_address_signature>(
+			initiate_get_address(), token, &socket, endpoint, cache, error);
 	}
 
 	/// @brief Get the IP address from a STUN server. Preserves the socket's non-blocking
@@ -163,42 +296,9 @@ namespace asio_miniSTUN::detail
 	/// @param timeout The socket timeout
 	/// @param token The completion token
 	/// @return The deduced address from STUN
-	asio::ip::udp::endpoint get_address_impl(asio::ip::udp::socket& socket,
+	AMS_DECL asio::ip::udp::endpoint get_address_impl(asio::ip::udp::socket& socket,
 		const asio::ip::udp::endpoint& endpoint, 
-		const std::chrono::system_clock::duration& timeout, error_code& ec)
-	{
-		// ensure the socket is not already connected
-		if (socket.remote_endpoint(ec); !ec)
-			return {};
-		bool const non_blocking = socket.native_non_blocking();
-		// get old timeout
-		asio::detail::socket_option::integer<SOL_SOCKET, SO_RCVTIMEO> rcv_timeout;
-		if (socket.get_option(rcv_timeout, ec))
-			return {};
-		// set the new timeout
-		if (socket.set_option(asio::detail::socket_option::integer<SOL_SOCKET, SO_RCVTIMEO>(
-			static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count())), ec))
-			return {};
-		header const request(message_class::request);
-		xor_mapped_address response;
-		// disable non-blocking
-		socket.native_non_blocking(false);
-		// send the request
-		if (socket.send_to(request.to_const_buffers(), endpoint, 0, ec); !ec)
-		{
-			// receive the response until we get it from the STUN server
-			for (asio::ip::udp::endpoint recv_endpoint; recv_endpoint != endpoint;)
-			{
-				if (socket.receive_from(response.to_buffers(), recv_endpoint, 0, ec); ec)
-					break;
-			}
-		}
-		// return non-blocking and recv timeout
-		if (socket.native_non_blocking(non_blocking, ec) ||
-			socket.set_option(rcv_timeout, ec))
-			return {};
-		return asio::ip::udp::endpoint(response.addr(), response.port());
-	}
+		const std::chrono::system_clock::duration& timeout, error_code& ec);
 
 #if _WIN32
 	/// @brief Get the IP address from a STUN server. Preserves the socket's non-blocking
@@ -210,108 +310,14 @@ namespace asio_miniSTUN::detail
 	/// @param timeout The socket timeout
 	/// @param token The completion token
 	/// @return The deduced address from STUN
-	asio::ip::udp::endpoint get_address_impl(int socket,
+	AMS_DECL asio::ip::udp::endpoint get_address_impl(int socket,
 		const asio::ip::udp::endpoint& endpoint,
-		const std::chrono::system_clock::duration& timeout, error_code& ec)
-	{
-		// get old timeout
-		int rcv_timeout;
-		int rcv_timeout_len = sizeof(rcv_timeout);
-		if (getsockopt(socket, SOL_SOCKET, SO_RCVTIMEO,
-			reinterpret_cast<char*>(&rcv_timeout), &rcv_timeout_len) != 0)
-		{
-			ec = asio::error_code(GetLastError(), asio::system_category());
-			return {};
-		}
-		header request(message_class::request);
-		// form the buffers
-		auto buffers = collect<std::vector<WSABUF>>(request.to_const_buffers() | 
-			std::ranges::views::transform([](const asio::const_buffer& buf)
-				{
-					return WSABUF {
-						.len = static_cast<ULONG>(buf.size()),
-						.buf = const_cast<char*>(reinterpret_cast<char const*>(buf.data())),
-					};
-				}
-			));
-		// it may be non-blocking, so keep trying until we succeed
-		while (true)
-		{
-			DWORD bytes_sent;
-			int const send_res = WSASendTo(socket, buffers.data(),
-				static_cast<DWORD>(buffers.size()), &bytes_sent, 0,
-				endpoint.data(), sizeof(*endpoint.data()), nullptr,
-				nullptr);
-			if (send_res == 0)
-				break;
-			// we errored, see if it's because non-blocking
-			int const last_error = GetLastError();
-			if (last_error != WSAEWOULDBLOCK)
-			{
-				// error
-				ec = asio::error_code(last_error, asio::system_category());
-				return {};
-			}
-		};
-		// receive the response until we get it from the STUN server.
-		xor_mapped_address response;
-		// form the buffers
-		buffers = collect<std::vector<WSABUF>>(response.to_buffers() |
-			std::ranges::views::transform([](const asio::mutable_buffer& buf)
-				{
-					return WSABUF{
-						.len = static_cast<ULONG>(buf.size()),
-						.buf = reinterpret_cast<char*>(buf.data()),
-					};
-				}
-		));
-		// also keep track of the timeout :))))))
-		auto const start = std::chrono::system_clock::now();
-		while (true)
-		{
-			DWORD bytes_recvd;
-			sockaddr_in recv_addr{};
-			INT recv_len = sizeof(recv_addr);
-			DWORD flags = 0;
-			int const recv_res = WSARecvFrom(socket, buffers.data(),
-				static_cast<DWORD>(buffers.size()), &bytes_recvd, &flags,
-				reinterpret_cast<sockaddr*>(&recv_addr), &recv_len,
-				nullptr, nullptr);
-			if (recv_res == 0)
-			{
-				// ensure it's from the expected address
-				if (ntohl(recv_addr.sin_addr.S_un.S_addr) ==
-					endpoint.address().to_v4().to_uint() &&
-					ntohs(recv_addr.sin_port) == endpoint.port())
-					break;
-				// keep searching
-				continue;
-			}
-			// see if we timed out
-			if ((std::chrono::system_clock::now() - start) >= timeout)
-			{
-				ec = asio_miniSTUN::make_error_code(errc::timed_out);
-				break;
-			}
-			// we errored, see if it's because non-blocking
-			int const last_error = GetLastError();
-			if (last_error != WSAEWOULDBLOCK)
-			{
-				// error
-				ec = asio::error_code(last_error, asio::system_category());
-				return {};
-			}
-		}
-		// return recv timeout
-		if (setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, 
-			reinterpret_cast<char*>(&rcv_timeout), rcv_timeout_len) != 0)
-		{
-			ec = asio::error_code(GetLastError(), asio::system_category());
-			return {};
-		}
-		return asio::ip::udp::endpoint(response.addr(), response.port());
-	}
+		const std::chrono::system_clock::duration& timeout, error_code& ec);
 #endif
 }
 
+#ifdef AMS_HEADER_ONLY
+#include <asio-ministun/detail/impl/xor_mapped_address.ipp>
+#endif
+
 #endif
\ No newline at end of file
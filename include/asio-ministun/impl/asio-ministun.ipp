@@ -0,0 +1,47 @@
+/// @file asio-ministun.ipp
+/// @brief Implementation of the synchronous public API
+
+#ifndef AMS_IMPL_ASIOMINISTUN_IPP_
+#define AMS_IMPL_ASIOMINISTUN_IPP_
+
+// AMS includes
+#include <asio-ministun/asio-ministun.hpp>
+
+namespace asio_miniSTUN
+{
+	AMS_DECL asio::ip::udp::endpoint get_address(asio::ip::udp::socket& socket,
+		const asio::ip::udp::endpoint& endpoint,
+		const std::chrono::system_clock::duration& timeout, error_code& ec)
+	{
+		return detail::get_address_impl(socket, endpoint, timeout, ec);
+	}
+
+#if _WIN32
+	AMS_DECL asio::ip::udp::endpoint get_address(int socket,
+		const asio::ip::udp::endpoint& endpoint,
+		const std::chrono::system_clock::duration& timeout, error_code& ec)
+	{
+		return detail::get_address_impl(socket, endpoint, timeout, ec);
+	}
+#endif
+
+	AMS_DECL transaction_id make_transaction_id()
+	{
+		return detail::random_transaction_id();
+	}
+
+	AMS_DECL request make_request(const transaction_id& id) noexcept
+	{
+		return request(detail::message_class::request, id);
+	}
+
+	AMS_DECL size_t validate_responses(std::span<const response> responses,
+		std::span<const size_t> sizes, std::span<const transaction_id> pending,
+		std::span<std::optional<asio::ip::udp::endpoint>> endpoints,
+		std::span<size_t> matches) noexcept
+	{
+		return detail::validate_responses_impl(responses, sizes, pending, endpoints, matches);
+	}
+}
+
+#endif
@@ -0,0 +1,52 @@
+/// @file src.hpp
+/// @brief Separately compiled sources. Include in exactly one translation unit built
+/// with AMS_SEPARATE_COMPILATION, after asio
+
+#ifndef AMS_IMPL_SRC_HPP_
+#define AMS_IMPL_SRC_HPP_
+
+#ifndef AMS_SEPARATE_COMPILATION
+#error Define AMS_SEPARATE_COMPILATION to build the asio-ministun library
+#endif
+
+// AMS includes
+#include <asio-ministun/asio-ministun.hpp>
+#include <asio-ministun/detail/impl/batch.ipp>
+#include <asio-ministun/detail/impl/common.ipp>
+#include <asio-ministun/detail/impl/error.ipp>
+#include <asio-ministun/detail/impl/error_response.ipp>
+#include <asio-ministun/detail/impl/header.ipp>
+#include <asio-ministun/detail/impl/xor_mapped_address.ipp>
+#include <asio-ministun/impl/asio-ministun.ipp>
+
+namespace asio_miniSTUN
+{
+	template get_address_result_t<get_address_handler>
+		async_get_address<get_address_handler>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, get_address_handler&&);
+	template get_address_result_t<get_address_handler>
+		async_get_address<get_address_handler>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, redirect_cache&, get_address_handler&&);
+	template get_address_result_t<const get_address_handler&>
+		async_get_address<const get_address_handler&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, const get_address_handler&);
+	template get_address_result_t<const get_address_handler&>
+		async_get_address<const get_address_handler&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, redirect_cache&, const get_address_handler&);
+	template get_address_result_t<const asio::use_future_t<>&>
+		async_get_address<const asio::use_future_t<>&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, const asio::use_future_t<>&);
+	template get_address_result_t<const asio::use_future_t<>&>
+		async_get_address<const asio::use_future_t<>&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, redirect_cache&, const asio::use_future_t<>&);
+#ifdef AMS_HAS_CO_AWAIT
+	template get_address_result_t<const asio::use_awaitable_t<>&>
+		async_get_address<const asio::use_awaitable_t<>&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, const asio::use_awaitable_t<>&);
+	template get_address_result_t<const asio::use_awaitable_t<>&>
+		async_get_address<const asio::use_awaitable_t<>&>(asio::ip::udp::socket&,
+			const asio::ip::udp::endpoint&, redirect_cache&, const asio::use_awaitable_t<>&);
+#endif
+}
+
+#endif
@@ -0,0 +1,14 @@
+/// @file asio-ministun.cpp
+/// @brief The separately compiled asio-ministun library
+
+// ASIO includes <- note that this is before AMS
+#ifdef AMS_USE_BOOST
+// older Boost.Asio uses std::exchange in awaitable.hpp without including <utility>
+#include <utility>
+#include <boost/asio.hpp>
+#else
+#include <asio.hpp>
+#endif
+
+// AMS includes
+#include <asio-ministun/impl/src.hpp>
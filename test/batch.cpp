@@ -0,0 +1,177 @@
+/// @file batch.cpp
+/// @brief Checks that every bulk validation variant agrees with the scalar reference
+
+// ASIO includes <- note that this is before AMS
+#ifdef AMS_USE_BOOST
+// older Boost.Asio uses std::exchange in awaitable.hpp without including <utility>
+#include <utility>
+#include <boost/asio.hpp>
+#else
+#include <asio.hpp>
+#endif
+
+// AMS includes
+#include <asio-ministun/asio-ministun.hpp>
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace asio_miniSTUN;
+
+namespace
+{
+	/// @brief A batch of received responses and the outputs of one validation
+	struct batch
+	{
+		std::vector<response> responses;
+		std::vector<size_t> sizes;
+		std::vector<transaction_id> pending;
+		/// @brief The pending index each response was built for, or pending.size() if it
+		/// was built invalid
+		std::vector<size_t> expected;
+	};
+
+	/// @brief The outputs of one validation
+	struct result
+	{
+		size_t valid = 0;
+		std::vector<std::optional<asio::ip::udp::endpoint>> endpoints;
+		std::vector<size_t> matches;
+	};
+
+	/// @param rng The random number generator
+	/// @param count The number of responses
+	/// @return Responses answering a random pending set in random order, some of them
+	/// corrupted, unsolicited or truncated
+	batch make_batch(std::mt19937& rng, size_t count)
+	{
+		batch b;
+		b.pending.resize(count / 2 + 1);
+		for (auto& id : b.pending)
+			id = make_transaction_id();
+		std::sort(b.pending.begin(), b.pending.end());
+		b.responses.resize(count);
+		b.sizes.assign(count, sizeof(response));
+		b.expected.assign(count, b.pending.size());
+		for (size_t i = 0; i < count; ++i)
+		{
+			const size_t index = rng() % b.pending.size();
+			uint8_t raw[sizeof(response)] = { 0x01, 0x01, 0x00, 0x0c, 0x21, 0x12, 0xA4, 0x42 };
+			std::memcpy(raw + 8, b.pending[index].data(), b.pending[index].size());
+			const uint8_t attribute[] = { 0x00, 0x20, 0x00, 0x08, 0x00, 0x01 };
+			std::memcpy(raw + 20, attribute, sizeof(attribute));
+			for (size_t j = 26; j < sizeof(raw); ++j)
+				raw[j] = static_cast<uint8_t>(rng());
+			switch (rng() % 8)
+			{
+			case 0:
+				// flip a bit anywhere; the variants must still agree with each other
+				raw[rng() % sizeof(raw)] ^= static_cast<uint8_t>(1 << (rng() % 8));
+				break;
+			case 1:
+				// answer a transaction that is not pending
+				raw[8 + rng() % b.pending[index].size()] ^= 0x80;
+				break;
+			case 2:
+				b.sizes[i] = sizeof(response) - 1;
+				break;
+			default:
+				b.expected[i] = index;
+				break;
+			}
+			std::memcpy(&b.responses[i], raw, sizeof(raw));
+		}
+		return b;
+	}
+
+	/// @param b The batch
+	/// @param validate The variant to run
+	/// @return The outputs of the variant
+	template<typename Validate>
+	result run(const batch& b, Validate validate)
+	{
+		result r;
+		r.endpoints.resize(b.responses.size());
+		r.matches.resize(b.responses.size());
+		r.valid = validate(r.endpoints.data(), r.matches.data());
+		return r;
+	}
+
+	/// @param name The name of the variant
+	/// @param b The batch
+	/// @param reference The outputs of the scalar reference
+	/// @param r The outputs of the variant
+	/// @return The number of disagreements
+	size_t compare(const char* name, const batch& b, const result& reference, const result& r)
+	{
+		size_t errors = reference.valid != r.valid;
+		for (size_t i = 0; i < b.responses.size(); ++i)
+		{
+			if (r.endpoints[i] != reference.endpoints[i] || r.matches[i] != reference.matches[i])
+				++errors;
+			// responses built valid must be found, and a match must be the answered ID
+			if (b.expected[i] != b.pending.size() && r.matches[i] != b.expected[i])
+				++errors;
+			if (r.matches[i] != b.pending.size() &&
+				b.pending[r.matches[i]] != b.responses[i].headers().transaction_id())
+				++errors;
+		}
+		if (errors != 0)
+			std::cerr << name << ": " << errors << " disagreements\n";
+		return errors;
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(0x2112A442);
+	size_t errors = 0;
+	for (const size_t count : { 0, 1, 7, 64, 1000 })
+	{
+		const batch b = make_batch(rng, count);
+		const auto* responses = b.responses.data();
+		const auto* sizes = b.sizes.data();
+		const auto* pending = b.pending.data();
+		const size_t pending_count = b.pending.size();
+		const result reference = run(b, [&](auto* endpoints, auto* matches)
+		{
+			return detail::scalar::validate_responses(responses, sizes,
+				pending, pending_count, endpoints, matches, count);
+		});
+		errors += compare("scalar", b, reference, reference);
+		errors += compare("dispatch", b, reference, run(b, [&](auto* endpoints, auto* matches)
+		{
+			return validate_responses(b.responses, b.sizes, b.pending,
+				std::span(endpoints, count), std::span(matches, count));
+		}));
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+		if (detail::cpu_supports_sse2())
+		{
+			errors += compare("sse2", b, reference, run(b, [&](auto* endpoints, auto* matches)
+			{
+				return detail::sse2::validate_responses(responses, sizes,
+					pending, pending_count, endpoints, matches, count);
+			}));
+		}
+		if (detail::cpu_supports_avx2())
+		{
+			errors += compare("avx2", b, reference, run(b, [&](auto* endpoints, auto* matches)
+			{
+				return detail::avx2::validate_responses(responses, sizes,
+					pending, pending_count, endpoints, matches, count);
+			}));
+		}
+		else
+			std::cout << "avx2: not supported by this CPU, skipped\n";
+#endif
+	}
+	if (errors != 0)
+		return 1;
+	std::cout << "all variants agree\n";
+	return 0;
+}